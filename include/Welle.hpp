@@ -26,14 +26,624 @@ SOFTWARE.
 #ifndef WELLE_HPP
 #define WELLE_HPP
 
+#include <algorithm>
 #include <cmath>
+#include <complex>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <memory>
 #include <numbers>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
+#ifdef WELLE_USE_FFTW
+#include <fftw3.h>
+#include <mutex>
+#endif
+
+#ifdef WELLE_INSTRUMENTATION
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <locale>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <thread>
+#include <typeinfo>
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+namespace welle::instrumentation {
+
+/**
+ * Single generation call measurements
+ */
+struct GenerationEvent {
+  // generator type name as returned by std::type_info::name()
+  const char *generator;
+  // sample type name as returned by std::type_info::name()
+  const char *sampleType;
+  std::size_t samples;
+  std::size_t allocatedBytes;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::nanoseconds duration;
+  std::thread::id thread;
+
+  double samplesPerSecond() const {
+    return duration.count() > 0 ? samples * 1e9 / duration.count() : 0;
+  }
+};
+
+/**
+ * Generation calls measurements aggregated per generator and sample type
+ */
+struct Counters {
+  std::size_t calls = 0;
+  std::size_t samples = 0;
+  std::size_t allocatedBytes = 0;
+  std::chrono::nanoseconds duration{0};
+
+  double samplesPerSecond() const {
+    return duration.count() > 0 ? samples * 1e9 / duration.count() : 0;
+  }
+
+  Counters &operator+=(const Counters &other) {
+    calls += other.calls;
+    samples += other.samples;
+    allocatedBytes += other.allocatedBytes;
+    duration += other.duration;
+    return *this;
+  }
+};
+
+/**
+ * Demangled generator and sample type names
+ */
+using CountersKey = std::pair<std::string, std::string>;
+using Sink = void (*)(const GenerationEvent &);
+
+// distinct generator and sample type pairs counted per thread, others are
+// dropped
+inline constexpr std::size_t maxCountersPerThread = 64;
+// latest trace events kept per thread
+inline constexpr std::size_t traceCapacityPerThread = 1024;
+
+inline std::atomic<Sink> sink = nullptr;
+inline std::atomic<bool> tracing = false;
+inline const auto traceEpoch = std::chrono::steady_clock::now();
+
+/**
+ * Human-readable type name, demangled where supported
+ */
+inline std::string typeName(const char *name) {
+#if __has_include(<cxxabi.h>)
+  int status = 0;
+  std::unique_ptr<char, decltype(&std::free)> demangled(
+      abi::__cxa_demangle(name, nullptr, nullptr, &status), &std::free);
+  if (status == 0) {
+    return demangled.get();
+  }
+#endif
+  return name;
+}
+
+/**
+ * Measurements of a single thread. Only the owner thread writes, other
+ * threads read lock-free: counters are relaxed atomics, trace events are
+ * kept in a bounded ring buffer guarded by per-slot sequence numbers.
+ *
+ * Once the owner thread exits, the block is released and reused by the next
+ * thread. Its trace events are kept until overwritten.
+ */
+class ThreadBlock {
+public:
+  explicit ThreadBlock(const std::size_t index) : index{index} {}
+
+  std::size_t getIndex() const { return index; }
+
+  /**
+   * Get the thread currently owning this block, std::thread::id() if free
+   */
+  std::thread::id getThread() const { return owner.load(); }
+
+  void count(const GenerationEvent &event) {
+    const std::size_t size = countersSize.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < size; i++) {
+      if (counters[i].matches(event)) {
+        counters[i].add(event);
+        return;
+      }
+    }
+    if (size == maxCountersPerThread) {
+      return;
+    }
+
+    counters[size].generator.store(event.generator, std::memory_order_relaxed);
+    counters[size].sampleType.store(event.sampleType,
+                                    std::memory_order_relaxed);
+    counters[size].add(event);
+    countersSize.store(size + 1, std::memory_order_release);
+  }
+
+  void trace(const GenerationEvent &event) {
+    const std::uint64_t index = traceHead.load(std::memory_order_relaxed);
+    TraceSlot &slot = traceSlots[index % traceCapacityPerThread];
+
+    // odd sequence marks the slot being written
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.thread.store(event.thread, std::memory_order_relaxed);
+    slot.generator.store(event.generator, std::memory_order_relaxed);
+    slot.sampleType.store(event.sampleType, std::memory_order_relaxed);
+    slot.samples.store(event.samples, std::memory_order_relaxed);
+    slot.allocatedBytes.store(event.allocatedBytes, std::memory_order_relaxed);
+    slot.start.store((event.start - traceEpoch).count(),
+                     std::memory_order_relaxed);
+    slot.duration.store(event.duration.count(), std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+
+    traceHead.store(index + 1, std::memory_order_release);
+  }
+
+  /**
+   * Read counters, safe to call from any thread
+   */
+  std::map<CountersKey, Counters> snapshotCounters() const {
+    std::map<CountersKey, Counters> snapshot;
+    const std::size_t size = countersSize.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < size; i++) {
+      const CounterSlot &slot = counters[i];
+      Counters &result =
+          snapshot[CountersKey(typeName(slot.generator.load()),
+                               typeName(slot.sampleType.load()))];
+      result += Counters{
+          slot.calls.load(std::memory_order_relaxed),
+          slot.samples.load(std::memory_order_relaxed),
+          slot.allocatedBytes.load(std::memory_order_relaxed),
+          std::chrono::nanoseconds(
+              slot.nanoseconds.load(std::memory_order_relaxed))};
+    }
+    return snapshot;
+  }
+
+  /**
+   * Read trace events recorded since the last clearTrace(), safe to call
+   * from any thread. Events being overwritten at the moment are skipped.
+   */
+  std::vector<GenerationEvent> snapshotTrace() const {
+    const std::uint64_t head = traceHead.load(std::memory_order_acquire);
+    std::uint64_t first = traceStart.load(std::memory_order_relaxed);
+    if (head - first > traceCapacityPerThread) {
+      first = head - traceCapacityPerThread;
+    }
+
+    std::vector<GenerationEvent> events;
+    events.reserve(head - first);
+    for (std::uint64_t i = first; i < head; i++) {
+      const TraceSlot &slot = traceSlots[i % traceCapacityPerThread];
+      if (slot.sequence.load(std::memory_order_acquire) != 2 * i + 2) {
+        continue;
+      }
+      const GenerationEvent event{
+          slot.generator.load(std::memory_order_relaxed),
+          slot.sampleType.load(std::memory_order_relaxed),
+          slot.samples.load(std::memory_order_relaxed),
+          slot.allocatedBytes.load(std::memory_order_relaxed),
+          traceEpoch + std::chrono::steady_clock::duration(
+                           slot.start.load(std::memory_order_relaxed)),
+          std::chrono::nanoseconds(
+              slot.duration.load(std::memory_order_relaxed)),
+          slot.thread.load(std::memory_order_relaxed)};
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) == 2 * i + 2) {
+        events.push_back(event);
+      }
+    }
+    return events;
+  }
+
+  void resetCounters() {
+    const std::size_t size = countersSize.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < size; i++) {
+      counters[i].calls.store(0, std::memory_order_relaxed);
+      counters[i].samples.store(0, std::memory_order_relaxed);
+      counters[i].allocatedBytes.store(0, std::memory_order_relaxed);
+      counters[i].nanoseconds.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  void clearTrace() {
+    traceStart.store(traceHead.load(std::memory_order_acquire),
+                     std::memory_order_relaxed);
+  }
+
+  void acquire(const std::thread::id thread) { owner.store(thread); }
+
+  /**
+   * Free the block for another thread, counters must be read beforehand
+   */
+  void release() {
+    resetCounters();
+    countersSize.store(0, std::memory_order_release);
+    owner.store(std::thread::id());
+  }
+
+private:
+  struct CounterSlot {
+    std::atomic<const char *> generator = nullptr;
+    std::atomic<const char *> sampleType = nullptr;
+    std::atomic<std::uint64_t> calls = 0;
+    std::atomic<std::uint64_t> samples = 0;
+    std::atomic<std::uint64_t> allocatedBytes = 0;
+    std::atomic<std::int64_t> nanoseconds = 0;
+
+    bool matches(const GenerationEvent &event) const {
+      const char *slotGenerator = generator.load(std::memory_order_relaxed);
+      const char *slotSampleType = sampleType.load(std::memory_order_relaxed);
+      return (slotGenerator == event.generator ||
+              std::strcmp(slotGenerator, event.generator) == 0) &&
+             (slotSampleType == event.sampleType ||
+              std::strcmp(slotSampleType, event.sampleType) == 0);
+    }
+
+    // read-modify-write, so resetCounters() from another thread isn't lost
+    void add(const GenerationEvent &event) {
+      calls.fetch_add(1, std::memory_order_relaxed);
+      samples.fetch_add(event.samples, std::memory_order_relaxed);
+      allocatedBytes.fetch_add(event.allocatedBytes, std::memory_order_relaxed);
+      nanoseconds.fetch_add(event.duration.count(), std::memory_order_relaxed);
+    }
+  };
+
+  struct TraceSlot {
+    // 2 * index + 2 once event index is written
+    std::atomic<std::uint64_t> sequence = 0;
+    std::atomic<std::thread::id> thread;
+    std::atomic<const char *> generator = nullptr;
+    std::atomic<const char *> sampleType = nullptr;
+    std::atomic<std::size_t> samples = 0;
+    std::atomic<std::size_t> allocatedBytes = 0;
+    std::atomic<std::int64_t> start = 0;
+    std::atomic<std::int64_t> duration = 0;
+  };
+
+  const std::size_t index;
+  std::atomic<std::thread::id> owner;
+
+  std::atomic<std::size_t> countersSize = 0;
+  std::array<CounterSlot, maxCountersPerThread> counters;
+
+  std::atomic<std::uint64_t> traceHead = 0;
+  std::atomic<std::uint64_t> traceStart = 0;
+  std::array<TraceSlot, traceCapacityPerThread> traceSlots;
+};
+
+// blocks of exited threads are reused, so the registry only grows up to the
+// number of threads generating at the same time
+inline std::mutex registryMutex;
+inline std::vector<std::shared_ptr<ThreadBlock>> registry;
+// counters of exited threads
+inline std::map<CountersKey, Counters> retiredCounters;
+
+/**
+ * Ownership of a registry block for the lifetime of a thread
+ */
+class ThreadBlockLease {
+public:
+  ThreadBlockLease() {
+    std::lock_guard lock(registryMutex);
+    for (const auto &candidate : registry) {
+      if (candidate->getThread() == std::thread::id()) {
+        block = candidate.get();
+        break;
+      }
+    }
+    if (block == nullptr) {
+      registry.push_back(std::make_shared<ThreadBlock>(registry.size() + 1));
+      block = registry.back().get();
+    }
+    block->acquire(std::this_thread::get_id());
+  }
+
+  ThreadBlockLease(const ThreadBlockLease &) = delete;
+  ThreadBlockLease &operator=(const ThreadBlockLease &) = delete;
+
+  ~ThreadBlockLease() {
+    std::lock_guard lock(registryMutex);
+    try {
+      for (const auto &[key, counters] : block->snapshotCounters()) {
+        retiredCounters[key] += counters;
+      }
+    } catch (const std::bad_alloc &) {
+      // counters of this thread are lost, the block is still reused
+    }
+    block->release();
+  }
+
+  ThreadBlock &get() const { return *block; }
+
+private:
+  ThreadBlock *block = nullptr;
+};
+
+/**
+ * Get measurements block of the current thread, registered on first use
+ */
+inline ThreadBlock &threadBlock() {
+  thread_local const ThreadBlockLease lease;
+  return lease.get();
+}
+
+/**
+ * Get measurement blocks of all threads making generation calls, including
+ * free blocks which still hold trace events of exited threads
+ */
+inline std::vector<std::shared_ptr<const ThreadBlock>> threadBlocks() {
+  std::lock_guard lock(registryMutex);
+  return {registry.begin(), registry.end()};
+}
+
+/**
+ * Set callback invoked after each successful generation call, nullptr to
+ * disable. The callback must not throw: it runs in a destructor, so an
+ * exception terminates the program.
+ */
+inline void setSink(const Sink callback) { sink = callback; }
+
+/**
+ * Start or stop recording events for the Chrome trace dump
+ */
+inline void setTracing(const bool enabled) { tracing = enabled; }
+
+/**
+ * Counters of generation calls made by the current thread
+ */
+inline std::map<CountersKey, Counters> threadCounters() {
+  return threadBlock().snapshotCounters();
+}
+
+/**
+ * Counters of generation calls made by all threads, safe to call from a
+ * monitoring thread
+ */
+inline std::map<CountersKey, Counters> snapshotCounters() {
+  // locked, so counters of a thread exiting meanwhile aren't lost or doubled
+  std::lock_guard lock(registryMutex);
+  std::map<CountersKey, Counters> snapshot = retiredCounters;
+  for (const auto &block : registry) {
+    for (const auto &[key, counters] : block->snapshotCounters()) {
+      snapshot[key] += counters;
+    }
+  }
+  return snapshot;
+}
+
+/**
+ * Zero counters of all threads
+ */
+inline void resetCounters() {
+  std::lock_guard lock(registryMutex);
+  retiredCounters.clear();
+  for (const auto &block : registry) {
+    block->resetCounters();
+  }
+}
+
+/**
+ * Drop trace events recorded by all threads
+ */
+inline void clearTrace() {
+  std::lock_guard lock(registryMutex);
+  for (const auto &block : registry) {
+    block->clearTrace();
+  }
+}
+
+/**
+ * Write trace events of all threads in Chrome trace JSON format, viewable
+ * with chrome://tracing or Perfetto. Trace tid is the measurement block index,
+ * shared by threads which used the same block one after another.
+ */
+inline void writeChromeTrace(std::ostream &out) {
+  const auto escape = [](std::string value) {
+    std::string escaped;
+    for (const char c : value) {
+      if (c == '"' || c == '\\') {
+        escaped += '\\';
+      }
+      escaped += c;
+    }
+    return escaped;
+  };
+  // fixed point microseconds keep nanosecond resolution however long the
+  // process runs
+  const auto microseconds = [](const auto duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+  };
+
+  // JSON numbers must not depend on the stream locale or float format
+  std::ostringstream json;
+  json.imbue(std::locale::classic());
+  json << std::fixed << std::setprecision(3);
+
+  bool first = true;
+  json << "{\"traceEvents\":[";
+  for (const auto &block : threadBlocks()) {
+    for (const GenerationEvent &event : block->snapshotTrace()) {
+      json << (first ? "" : ",") << "{\"name\":\""
+          << escape(typeName(event.generator))
+          << "\",\"cat\":\"welle\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+          << block->getIndex()
+          << ",\"ts\":" << microseconds(event.start - traceEpoch)
+          << ",\"dur\":" << microseconds(event.duration)
+          << ",\"args\":{\"sampleType\":\""
+          << escape(typeName(event.sampleType))
+          << "\",\"samples\":" << event.samples
+          << ",\"allocatedBytes\":" << event.allocatedBytes
+          << ",\"samplesPerSecond\":" << event.samplesPerSecond() << "}}";
+      first = false;
+    }
+  }
+  json << "]}";
+  out << json.str();
+}
+
+/**
+ * Measures a generation call from construction till destruction. Calls left
+ * by an exception are not recorded.
+ */
+class Scope {
+public:
+  // thread block is registered here, so the destructor doesn't allocate
+  Scope(const char *generator, const char *sampleType,
+        const std::size_t samples, const std::size_t allocatedBytes)
+      : block{threadBlock()}, uncaughtExceptions{std::uncaught_exceptions()},
+        event{generator,
+              sampleType,
+              samples,
+              allocatedBytes,
+              std::chrono::steady_clock::now(),
+              std::chrono::nanoseconds{0},
+              std::this_thread::get_id()} {}
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+  /**
+   * Account allocations which are only known in the middle of the call
+   */
+  void addAllocatedBytes(const std::size_t bytes) {
+    event.allocatedBytes += bytes;
+  }
+
+  ~Scope() {
+    if (std::uncaught_exceptions() > uncaughtExceptions) {
+      return;
+    }
+    event.duration = std::chrono::steady_clock::now() - event.start;
+
+    block.count(event);
+    if (const Sink callback = sink) {
+      callback(event);
+    }
+    if (tracing) {
+      block.trace(event);
+    }
+  }
+
+private:
+  ThreadBlock &block;
+  const int uncaughtExceptions;
+  GenerationEvent event;
+};
+
+} // namespace welle::instrumentation
+
+#define WELLE_INSTRUMENT(generator, T, samples, allocatedBytes)                \
+  ::welle::instrumentation::Scope welleInstrumentationScope(                   \
+      typeid(generator).name(), typeid(T).name(), samples, allocatedBytes)
+#define WELLE_INSTRUMENT_ALLOCATION(allocatedBytes)                            \
+  welleInstrumentationScope.addAllocatedBytes(allocatedBytes)
+#else
+#define WELLE_INSTRUMENT(generator, T, samples, allocatedBytes)
+#define WELLE_INSTRUMENT_ALLOCATION(allocatedBytes)
+#endif // WELLE_INSTRUMENTATION
+
+// WELLE_INSTRUMENTATION and WELLE_USE_FFTW change inline function bodies and
+// class layouts, so they should be defined for the whole project. Each
+// configuration gets its own inline namespace, so translation units built
+// with different definitions use separate copies of the library instead of
+// the linker silently picking one of the bodies. Welle types passed between
+// such translation units are distinct types: a function declared in one and
+// defined in the other fails to link.
+#if defined(WELLE_INSTRUMENTATION) && defined(WELLE_USE_FFTW)
+#define WELLE_ABI_NAMESPACE abi_instrumented_fftw
+#elif defined(WELLE_INSTRUMENTATION)
+#define WELLE_ABI_NAMESPACE abi_instrumented
+#elif defined(WELLE_USE_FFTW)
+#define WELLE_ABI_NAMESPACE abi_fftw
+#else
+#define WELLE_ABI_NAMESPACE abi_default
+#endif
+
 namespace welle {
+inline namespace WELLE_ABI_NAMESPACE {
+namespace detail {
+
+inline void checkSamplingRate(const int samplingRate) {
+  if (samplingRate < 1) {
+    throw std::invalid_argument("samplingRate must be >= 1");
+  }
+}
+
+inline void checkFrequency(const int frequency) {
+  if (frequency < 1) {
+    throw std::invalid_argument("frequency must be >= 1");
+  }
+}
+
+template <typename T> inline void checkAmplitude(const double amplitude) {
+  constexpr double minAmplitude =
+      std::is_unsigned<T>() || std::is_floating_point<T>() ? 1 : 2;
+  if (amplitude < minAmplitude) {
+    std::string errorMsg = "peak-to-peak amplitude must be >= ";
+    errorMsg += std::to_string(minAmplitude);
+    throw std::invalid_argument(errorMsg);
+  }
+}
+
+/**
+ * Nyquist frequency defines max possible frequency
+ * to be digitally captured with a given sampling rate
+ *
+ * @param samplingRate sampling rate (Hz) (must be >=1)
+ * @return max possible frequency (Hz)
+ */
+inline int nyquistFrequency(const int samplingRate) {
+  checkSamplingRate(samplingRate);
+
+  return samplingRate / 2;
+}
+
+inline void checkFrequencyVsSamplingRate(const int frequency,
+                                         const int samplingRate) {
+  if (frequency > nyquistFrequency(samplingRate)) {
+    throw std::invalid_argument(
+        "frequency must be < samplingRate / 2 (Nyquist frequency)");
+  }
+}
+
+/**
+ * Calculate how many samples will take a single-period wave with a given
+ * frequency and sampling rate
+ *
+ * @param samplingRate sampling rate (Hz) (must be >=1)
+ * @param frequency target wave frequency (must be >= 1 and <= Nyquist
+ * frequency)
+ * @return number of samples to represent one period
+ */
+inline int calculatePeriodSamplesCount(const int samplingRate,
+                                       const int frequency) {
+  checkSamplingRate(samplingRate);
+  checkFrequency(frequency);
+  checkFrequencyVsSamplingRate(frequency, samplingRate);
+
+  return std::ceil(samplingRate / (double)frequency);
+}
+
+} // namespace detail
+
 /**
  * Base class for wave generation
  */
@@ -47,7 +657,7 @@ public:
             return 0;
           }
         }()) {
-    checkSamplingRate(samplingRate);
+    detail::checkSamplingRate(samplingRate);
   }
 
   virtual ~Wave() {}
@@ -68,10 +678,13 @@ public:
    */
   virtual std::vector<T> generatePeriod(const int frequency, const double peakToPeak,
                                         const double phaseShift = 0) const {
-    checkFrequency(frequency);
-    checkAmplitude(peakToPeak);
+    detail::checkFrequency(frequency);
+    detail::checkAmplitude<T>(peakToPeak);
+
+    const int period =
+        detail::calculatePeriodSamplesCount(samplingRate, frequency);
+    WELLE_INSTRUMENT(*this, T, period, period * sizeof(T));
 
-    const int period = calculatePeriodSamplesCount(samplingRate, frequency);
     std::vector<T> samples;
     samples.reserve(period);
 
@@ -84,6 +697,9 @@ public:
   }
 
 protected:
+  // composition leaf evaluates samples one by one
+  template <typename> friend class WaveTerm;
+
   const int samplingRate;
   const int dcOffset;
 
@@ -103,65 +719,6 @@ protected:
     return std::fmod(phaseShift, 2 * std::numbers::pi) /
            (2 * std::numbers::pi) * period;
   }
-
-private:
-  /**
-   * Nyquist frequency defines max possible frequency
-   * to be digitally captured with a given sampling rate
-   *
-   * @param samplingRate sampling rate (Hz) (must be >=1)
-   * @return max possible frequency (Hz)
-   */
-  static inline int nyquistFrequency(const int samplingRate) {
-    checkSamplingRate(samplingRate);
-
-    return samplingRate / 2;
-  }
-
-  /**
-   * Calculate how many samples will take a single-period wave with a given
-   * frequency and sampling rate
-   *
-   * @param samplingRate sampling rate (Hz) (must be >=1)
-   * @param frequency target wave frequency (must be >= 1 and <= Nyquist
-   * frequency)
-   * @return number of samples to represent one period
-   */
-  static int calculatePeriodSamplesCount(const int samplingRate,
-                                         const int frequency) {
-    checkSamplingRate(samplingRate);
-    checkFrequency(frequency);
-    checkFrequencyVsSamplingRate(frequency, samplingRate);
-
-    return std::ceil(samplingRate / (double)frequency);
-  }
-
-  static inline void checkSamplingRate(const int samplingRate) {
-    if (samplingRate < 1) {
-      throw std::invalid_argument("samplingRate must be >= 1");
-    }
-  }
-  static inline void checkFrequency(const int frequency) {
-    if (frequency < 1) {
-      throw std::invalid_argument("frequency must be >= 1");
-    }
-  }
-  static inline void checkAmplitude(const double amplitude) {
-    constexpr double minAmplitude =
-        std::is_unsigned<T>() || std::is_floating_point<T>() ? 1 : 2;
-    if (amplitude < minAmplitude) {
-      std::string errorMsg = "peak-to-peak amplitude must be >= ";
-      errorMsg += std::to_string(minAmplitude);
-      throw std::invalid_argument(errorMsg);
-    }
-  }
-  static inline void checkFrequencyVsSamplingRate(const int frequency,
-                                           const int samplingRate) {
-    if (frequency > nyquistFrequency(samplingRate)) {
-      throw std::invalid_argument(
-          "frequency must be < samplingRate / 2 (Nyquist frequency)");
-    }
-  }
 };
 
 /**
@@ -172,6 +729,8 @@ public:
   using Wave<T>::Wave;
 
 protected:
+  template <typename> friend class WaveTerm;
+
   inline T calculateSampleAtIndex(const int i, const int period,
                                   const double peakToPeak,
                                   const double phaseShift) const override {
@@ -209,6 +768,8 @@ public:
   using Wave<T>::Wave;
 
 protected:
+  template <typename> friend class WaveTerm;
+
   inline T calculateSampleAtIndex(const int i, const int period,
                                   const double peakToPeak,
                                   const double phaseShift) const override {
@@ -228,6 +789,8 @@ public:
   using Wave<T>::Wave;
 
 protected:
+  template <typename> friend class WaveTerm;
+
   inline T calculateSampleAtIndex(const int i, const int period,
                                   const double peakToPeak,
                                   const double phaseShift) const override {
@@ -247,6 +810,8 @@ public:
   using Wave<T>::Wave;
 
 protected:
+  template <typename> friend class WaveTerm;
+
   inline T calculateSampleAtIndex(const int i, const int period,
                                   const double peakToPeak,
                                   const double phaseShift) const override {
@@ -258,6 +823,946 @@ protected:
   }
 };
 
+namespace detail {
+
+/**
+ * Complex multiplication without the NaN recovery of std::complex operator*,
+ * which compiles to a __muldc3 call
+ */
+inline std::complex<double> multiply(const std::complex<double> a,
+                                     const std::complex<double> b) {
+  return {a.real() * b.real() - a.imag() * b.imag(),
+          a.real() * b.imag() + a.imag() * b.real()};
+}
+
+/**
+ * Direct (unnormalized) complex Fast Fourier Transform of a fixed size with
+ * precomputed twiddle factors and scratch buffers.
+ *
+ * Sizes made of prime factors up to maxRadix are transformed with a
+ * mixed-radix self-sorting (Stockham) algorithm. Other sizes use Bluestein's
+ * algorithm as a power of two convolution, so the cost stays O(N log N).
+ */
+class FourierPlan {
+public:
+  static constexpr std::size_t maxRadix = 13;
+
+  explicit FourierPlan(const std::size_t size) : size{size} {
+    std::size_t rest = size;
+    while (rest % 4 == 0) {
+      radices.push_back(4);
+      rest /= 4;
+    }
+    for (std::size_t radix = 2; radix <= maxRadix; radix++) {
+      while (rest % radix == 0) {
+        radices.push_back(radix);
+        rest /= radix;
+      }
+    }
+
+    if (rest == 1) {
+      roots.reserve(size);
+      for (std::size_t k = 0; k < size; k++) {
+        roots.push_back(std::polar(1.0, -2 * std::numbers::pi * k / size));
+      }
+      // radix-point DFT matrices of generic radices, in stages order
+      for (const std::size_t radix : radices) {
+        if (radix != 2 && radix != 4) {
+          for (std::size_t j = 0; j < radix; j++) {
+            for (std::size_t t = 0; t < radix; t++) {
+              kernels.push_back(roots[(j * t % radix) * (size / radix)]);
+            }
+          }
+        }
+      }
+      scratch.resize(size);
+    } else {
+      initBluestein();
+    }
+  }
+
+  std::size_t getSize() const { return size; }
+
+  /**
+   * Get bytes allocated for twiddle factors and scratch buffers
+   */
+  std::size_t allocatedBytes() const {
+    return sizeof(FourierPlan) + radices.capacity() * sizeof(std::size_t) +
+           (roots.capacity() + kernels.capacity() + scratch.capacity() +
+            chirp.capacity() + chirpSpectrum.capacity()) *
+               sizeof(std::complex<double>) +
+           (convolution ? convolution->allocatedBytes() : 0);
+  }
+
+  /**
+   * Perform direct transform in place
+   *
+   * @param samples buffer of plan size
+   */
+  void transform(std::complex<double> *samples) {
+    if (convolution) {
+      bluesteinTransform(samples);
+    } else {
+      stockhamTransform(samples);
+    }
+  }
+
+private:
+  const std::size_t size;
+  std::vector<std::size_t> radices;
+  // e^(-2*pi*i*k/size)
+  std::vector<std::complex<double>> roots;
+  std::vector<std::complex<double>> kernels;
+  std::vector<std::complex<double>> scratch;
+
+  // Bluestein's algorithm state
+  std::unique_ptr<FourierPlan> convolution;
+  std::vector<std::complex<double>> chirp;
+  std::vector<std::complex<double>> chirpSpectrum;
+
+  void initBluestein() {
+    radices.clear();
+
+    std::size_t m = 1;
+    while (m < 2 * size - 1) {
+      m <<= 1;
+    }
+    convolution = std::make_unique<FourierPlan>(m);
+
+    // e^(-i*pi*k^2/n), k^2 is taken modulo 2n to keep the angle precise
+    chirp.reserve(size);
+    for (std::size_t k = 0; k < size; k++) {
+      chirp.push_back(std::polar(
+          1.0, -std::numbers::pi * static_cast<double>((k * k) % (2 * size)) /
+                   size));
+    }
+
+    chirpSpectrum.resize(m);
+    chirpSpectrum[0] = std::conj(chirp[0]);
+    for (std::size_t k = 1; k < size; k++) {
+      chirpSpectrum[k] = chirpSpectrum[m - k] = std::conj(chirp[k]);
+    }
+    convolution->transform(chirpSpectrum.data());
+
+    scratch.resize(m);
+  }
+
+  void bluesteinTransform(std::complex<double> *samples) {
+    const std::size_t m = scratch.size();
+
+    for (std::size_t k = 0; k < size; k++) {
+      scratch[k] = multiply(samples[k], chirp[k]);
+    }
+    std::fill(scratch.begin() + size, scratch.end(), 0);
+
+    // convolution with the chirp, inverse transform is a direct one of the
+    // conjugated spectrum
+    convolution->transform(scratch.data());
+    for (std::size_t k = 0; k < m; k++) {
+      scratch[k] = std::conj(multiply(scratch[k], chirpSpectrum[k]));
+    }
+    convolution->transform(scratch.data());
+
+    for (std::size_t k = 0; k < size; k++) {
+      samples[k] = multiply(std::conj(scratch[k]), chirp[k]) / (double)m;
+    }
+  }
+
+  void stockhamTransform(std::complex<double> *samples) {
+    std::complex<double> *x = samples;
+    std::complex<double> *y = scratch.data();
+    std::size_t length = size;
+    std::size_t stride = 1;
+    std::size_t kernelOffset = 0;
+    std::complex<double> twiddles[maxRadix];
+    std::complex<double> a[maxRadix];
+
+    for (const std::size_t radix : radices) {
+      const std::size_t m = length / radix;
+      const std::size_t rootStep = size / length;
+      const std::complex<double> *kernel = kernels.data() + kernelOffset;
+
+      for (std::size_t p = 0; p < m; p++) {
+        const std::complex<double> *in = x + stride * p;
+        std::complex<double> *out = y + stride * radix * p;
+
+        if (radix == 2) {
+          const std::complex<double> w1 = roots[p * rootStep];
+          for (std::size_t q = 0; q < stride; q++) {
+            const std::complex<double> a0 = in[q];
+            const std::complex<double> a1 = in[q + stride * m];
+            out[q] = a0 + a1;
+            out[q + stride] = multiply(a0 - a1, w1);
+          }
+        } else if (radix == 4) {
+          const std::complex<double> w1 = roots[p * rootStep];
+          const std::complex<double> w2 = roots[2 * p * rootStep];
+          const std::complex<double> w3 = roots[3 * p * rootStep];
+          for (std::size_t q = 0; q < stride; q++) {
+            const std::complex<double> a0 = in[q];
+            const std::complex<double> a1 = in[q + stride * m];
+            const std::complex<double> a2 = in[q + 2 * stride * m];
+            const std::complex<double> a3 = in[q + 3 * stride * m];
+            const std::complex<double> b0 = a0 + a2;
+            const std::complex<double> b1 = a0 - a2;
+            const std::complex<double> b2 = a1 + a3;
+            // (a1 - a3) * -i
+            const std::complex<double> b3(a1.imag() - a3.imag(),
+                                          a3.real() - a1.real());
+            out[q] = b0 + b2;
+            out[q + stride] = multiply(b1 + b3, w1);
+            out[q + 2 * stride] = multiply(b0 - b2, w2);
+            out[q + 3 * stride] = multiply(b1 - b3, w3);
+          }
+        } else {
+          for (std::size_t t = 0; t < radix; t++) {
+            twiddles[t] = roots[p * t * rootStep];
+          }
+          for (std::size_t q = 0; q < stride; q++) {
+            for (std::size_t j = 0; j < radix; j++) {
+              a[j] = in[q + j * stride * m];
+            }
+            for (std::size_t t = 0; t < radix; t++) {
+              std::complex<double> sum = a[0];
+              for (std::size_t j = 1; j < radix; j++) {
+                sum += multiply(a[j], kernel[j * radix + t]);
+              }
+              out[q + t * stride] = multiply(sum, twiddles[t]);
+            }
+          }
+        }
+      }
+
+      std::swap(x, y);
+      length = m;
+      stride *= radix;
+      if (radix != 2 && radix != 4) {
+        kernelOffset += radix * radix;
+      }
+    }
+
+    if (x != samples) {
+      std::copy(x, x + size, samples);
+    }
+  }
+};
+
+#ifdef WELLE_USE_FFTW
+inline std::mutex fftwPlannerMutex;
+
+/**
+ * Inverse (unnormalized) real Fast Fourier Transform of a fixed size,
+ * performed with FFTW
+ */
+class RealInversePlan {
+public:
+  explicit RealInversePlan(const std::size_t size)
+      : size{size}, input{fftw_alloc_complex(size / 2 + 1)},
+        output{fftw_alloc_real(size)} {
+    // FFTW planner is not thread safe
+    std::lock_guard lock(fftwPlannerMutex);
+    plan = fftw_plan_dft_c2r_1d(size, input, output, FFTW_ESTIMATE);
+  }
+
+  RealInversePlan(const RealInversePlan &) = delete;
+  RealInversePlan &operator=(const RealInversePlan &) = delete;
+
+  ~RealInversePlan() {
+    std::lock_guard lock(fftwPlannerMutex);
+    fftw_destroy_plan(plan);
+    fftw_free(input);
+    fftw_free(output);
+  }
+
+  std::size_t getSize() const { return size; }
+
+  /**
+   * Get bytes allocated for input and output buffers, excluding FFTW plan
+   */
+  std::size_t allocatedBytes() const {
+    return sizeof(RealInversePlan) + (size / 2 + 1) * sizeof(fftw_complex) +
+           size * sizeof(double);
+  }
+
+  /**
+   * @param spectrum size / 2 + 1 first bins of a real signal spectrum
+   * @param samples output buffer of plan size
+   */
+  void transform(const std::vector<std::complex<double>> &spectrum,
+                 double *samples) {
+    for (std::size_t k = 0; k <= size / 2; k++) {
+      input[k][0] = spectrum[k].real();
+      input[k][1] = spectrum[k].imag();
+    }
+    fftw_execute(plan);
+    std::copy(output, output + size, samples);
+  }
+
+private:
+  const std::size_t size;
+  fftw_complex *input;
+  double *output;
+  fftw_plan plan;
+};
+#else
+/**
+ * Inverse (unnormalized) real Fast Fourier Transform of a fixed size.
+ *
+ * Even sizes are computed as a half size complex transform of even and odd
+ * samples packed into real and imaginary parts.
+ */
+class RealInversePlan {
+public:
+  explicit RealInversePlan(const std::size_t size)
+      : size{size}, complexPlan(size % 2 == 0 ? size / 2 : size),
+        buffer(complexPlan.getSize()) {
+    if (size % 2 == 0) {
+      twiddles.reserve(size / 2);
+      for (std::size_t k = 0; k < size / 2; k++) {
+        twiddles.push_back(std::polar(1.0, 2 * std::numbers::pi * k / size));
+      }
+    }
+  }
+
+  std::size_t getSize() const { return size; }
+
+  /**
+   * Get bytes allocated for twiddle factors and scratch buffers
+   */
+  std::size_t allocatedBytes() const {
+    return sizeof(RealInversePlan) - sizeof(FourierPlan) +
+           complexPlan.allocatedBytes() +
+           (buffer.capacity() + twiddles.capacity()) *
+               sizeof(std::complex<double>);
+  }
+
+  /**
+   * @param spectrum size / 2 + 1 first bins of a real signal spectrum
+   * @param samples output buffer of plan size
+   */
+  void transform(const std::vector<std::complex<double>> &spectrum,
+                 double *samples) {
+    // inverse transform is a direct one of the conjugated spectrum
+    if (size % 2 == 0) {
+      const std::size_t half = size / 2;
+      for (std::size_t k = 0; k < half; k++) {
+        const std::complex<double> bin = spectrum[k];
+        const std::complex<double> mirror = std::conj(spectrum[half - k]);
+        const std::complex<double> odd = multiply(bin - mirror, twiddles[k]);
+        buffer[k] = std::conj(bin + mirror + std::complex<double>(-odd.imag(),
+                                                                  odd.real()));
+      }
+      complexPlan.transform(buffer.data());
+      for (std::size_t j = 0; j < half; j++) {
+        samples[2 * j] = buffer[j].real();
+        samples[2 * j + 1] = -buffer[j].imag();
+      }
+    } else {
+      buffer[0] = std::conj(spectrum[0]);
+      for (std::size_t k = 1; k <= size / 2; k++) {
+        buffer[k] = std::conj(spectrum[k]);
+        buffer[size - k] = spectrum[k];
+      }
+      complexPlan.transform(buffer.data());
+      for (std::size_t j = 0; j < size; j++) {
+        samples[j] = buffer[j].real();
+      }
+    }
+  }
+
+private:
+  const std::size_t size;
+  FourierPlan complexPlan;
+  std::vector<std::complex<double>> buffer;
+  // e^(2*pi*i*k/size)
+  std::vector<std::complex<double>> twiddles;
+};
+#endif // WELLE_USE_FFTW
+
+/**
+ * Per-thread plan of the most recently used size, so repeated periods of the
+ * same frequency skip twiddle factors and scratch buffers allocation
+ *
+ * @param size transform size
+ * @param allocatedBytes increased by the plan size if a new plan is created
+ */
+inline RealInversePlan &realInversePlan(const std::size_t size,
+                                        std::size_t &allocatedBytes) {
+  thread_local std::unique_ptr<RealInversePlan> plan;
+  if (!plan || plan->getSize() != size) {
+    plan.reset();
+    plan = std::make_unique<RealInversePlan>(size);
+    allocatedBytes += plan->allocatedBytes();
+  }
+
+  return *plan;
+}
+
+} // namespace detail
+
+/**
+ * Single harmonic of an additive wave
+ */
+struct Harmonic {
+  // amplitude relative to half of the peak-to-peak amplitude
+  double amplitude;
+  // harmonic phase in radians
+  double phase = 0;
+};
+
+/**
+ * Additive wave generator, sums sines at integer multiples of the base
+ * frequency. The whole period is built with a single inverse real FFT, so the
+ * cost is O(N log N) regardless of harmonics count. FFTW is used if
+ * WELLE_USE_FFTW is defined, otherwise the bundled transform.
+ *
+ * Harmonics above the Nyquist frequency are skipped. Keep the sum of absolute
+ * amplitudes <= 1 to stay within the requested peak-to-peak amplitude.
+ */
+template <typename T> class AdditiveWave : public Wave<T> {
+public:
+  /**
+   * @param samplingRate sampling rate (Hz) (must be >=1)
+   * @param harmonics amplitudes and phases, starting from the fundamental
+   */
+  AdditiveWave(const int samplingRate, std::vector<Harmonic> harmonics)
+      : Wave<T>(samplingRate), harmonics{std::move(harmonics)} {}
+
+  /**
+   * Get harmonics configured for this wave generator
+   */
+  const std::vector<Harmonic> &getHarmonics() const { return harmonics; }
+
+  std::vector<T> generatePeriod(const int frequency, const double peakToPeak,
+                                const double phaseShift = 0) const override {
+    detail::checkFrequency(frequency);
+    detail::checkAmplitude<T>(peakToPeak);
+
+    const int period =
+        detail::calculatePeriodSamplesCount(this->samplingRate, frequency);
+    WELLE_INSTRUMENT(*this, T, period,
+                     period * (sizeof(T) + sizeof(double)) +
+                         (period / 2 + 1) * sizeof(std::complex<double>));
+
+    // a*sin(x) = Re(-i*a*e^(ix)), so each harmonic takes a single bin of the
+    // real signal spectrum, split in halves between k and N-k bins
+    std::vector<std::complex<double>> spectrum(period / 2 + 1);
+    for (int k = 1; k <= (int)harmonics.size() && 2 * k <= period; k++) {
+      const Harmonic &harmonic = harmonics[k - 1];
+      const double angle = k * phaseShift + harmonic.phase;
+      const std::complex<double> bin(harmonic.amplitude * sin(angle),
+                                     -harmonic.amplitude * cos(angle));
+      spectrum[k] = 2 * k == period ? bin.real() : bin / 2.0;
+    }
+
+    std::vector<double> wave(period);
+    std::size_t planBytes = 0;
+    detail::realInversePlan(period, planBytes)
+        .transform(spectrum, wave.data());
+    WELLE_INSTRUMENT_ALLOCATION(planBytes);
+
+    std::vector<T> samples;
+    samples.reserve(period);
+
+    for (int i = 0; i < period; i++) {
+      samples.push_back((wave[i] + this->dcOffset) * peakToPeak / 2);
+    }
+
+    return samples;
+  }
+
+protected:
+  template <typename> friend class WaveTerm;
+
+  inline T calculateSampleAtIndex(const int i, const int period,
+                                  const double peakToPeak,
+                                  const double phaseShift) const override {
+    double sum = 0;
+    for (int k = 1; k <= (int)harmonics.size() && 2 * k <= period; k++) {
+      sum += harmonics[k - 1].amplitude *
+             sin(2 * std::numbers::pi * k * i / period + k * phaseShift +
+                 harmonics[k - 1].phase);
+    }
+
+    return (sum + this->dcOffset) * peakToPeak / 2;
+  }
+
+private:
+  const std::vector<Harmonic> harmonics;
+};
+
+namespace detail {
+
+template <typename U> U waveSampleType(const Wave<U> &);
+
+/**
+ * Convert a real sample value to T, rounding and saturating to T limits for
+ * integer types
+ */
+template <typename T> inline T saturate(const double value) {
+  if constexpr (std::is_integral<T>()) {
+    const double rounded = std::round(value);
+    if (rounded <= std::numeric_limits<T>::lowest()) {
+      return std::numeric_limits<T>::lowest();
+    }
+    if (rounded >= std::numeric_limits<T>::max()) {
+      return std::numeric_limits<T>::max();
+    }
+    return static_cast<T>(rounded);
+  } else {
+    return static_cast<T>(value);
+  }
+}
+
+} // namespace detail
+
+/**
+ * Any of the Wave<T> generators with floating point T. Integer generators
+ * already add their own DC offset and truncate samples, so they can't be
+ * summed without distortion.
+ */
+template <typename W>
+concept RealWaveGenerator =
+    std::floating_point<decltype(detail::waveSampleType(
+        std::declval<const W &>()))> &&
+    std::derived_from<W, Wave<decltype(detail::waveSampleType(
+                             std::declval<const W &>()))>>;
+
+/**
+ * Composition leaf evaluating a single wave generator
+ */
+template <typename W> class WaveTerm {
+public:
+  explicit WaveTerm(const W &wave) : wave{wave} {}
+
+  int getSamplingRate() const { return wave.getSamplingRate(); }
+
+  inline double operator()(const int i, const int period,
+                           const double peakToPeak,
+                           const double phaseShift) const {
+    if constexpr (requires {
+                    wave.W::calculateSampleAtIndex(i, period, peakToPeak,
+                                                   phaseShift);
+                  }) {
+      // qualified call is resolved at compile time and inlined into the loop
+      return wave.W::calculateSampleAtIndex(i, period, peakToPeak, phaseShift);
+    } else {
+      // generators not befriending WaveTerm are called virtually
+      using Base = Wave<decltype(detail::waveSampleType(wave))>;
+      return static_cast<const Base &>(wave).calculateSampleAtIndex(
+          i, period, peakToPeak, phaseShift);
+    }
+  }
+
+private:
+  const W wave;
+};
+
+/**
+ * Composition node summing two expressions
+ */
+template <typename L, typename R> class WaveSum {
+public:
+  WaveSum(const L &left, const R &right) : left{left}, right{right} {
+    if (left.getSamplingRate() != right.getSamplingRate()) {
+      throw std::invalid_argument("composed waves must have same samplingRate");
+    }
+  }
+
+  int getSamplingRate() const { return left.getSamplingRate(); }
+
+  inline double operator()(const int i, const int period,
+                           const double peakToPeak,
+                           const double phaseShift) const {
+    return left(i, period, peakToPeak, phaseShift) +
+           right(i, period, peakToPeak, phaseShift);
+  }
+
+private:
+  const L left;
+  const R right;
+};
+
+/**
+ * Composition node multiplying expression by a constant factor
+ */
+template <typename E> class WaveScale {
+public:
+  WaveScale(const E &expression, const double factor)
+      : expression{expression}, factor{factor} {}
+
+  int getSamplingRate() const { return expression.getSamplingRate(); }
+
+  inline double operator()(const int i, const int period,
+                           const double peakToPeak,
+                           const double phaseShift) const {
+    return expression(i, period, peakToPeak, phaseShift) * factor;
+  }
+
+private:
+  const E expression;
+  const double factor;
+};
+
+/**
+ * Composition node adding a constant DC offset to expression
+ */
+template <typename E> class WaveOffset {
+public:
+  WaveOffset(const E &expression, const double offset)
+      : expression{expression}, offset{offset} {}
+
+  int getSamplingRate() const { return expression.getSamplingRate(); }
+
+  inline double operator()(const int i, const int period,
+                           const double peakToPeak,
+                           const double phaseShift) const {
+    return expression(i, period, peakToPeak, phaseShift) + offset;
+  }
+
+private:
+  const E expression;
+  const double offset;
+};
+
+/**
+ * Mixture of wave generators evaluated in a single pass.
+ *
+ * Each composed generator must have a floating point sample type (e.g.
+ * SineWave<double>) and is evaluated at the same frequency, peak-to-peak
+ * amplitude and phase shift. The output type DC offset is added the same way
+ * as for Wave<T>, then the sum is rounded and saturated to T limits.
+ */
+template <typename E> class Composition {
+public:
+  explicit Composition(const E &expression) : expression{expression} {}
+
+  /**
+   * Get sampling rate (Hz) shared by all composed generators
+   */
+  int getSamplingRate() const { return expression.getSamplingRate(); }
+
+  /**
+   * Multiply the whole composition by a constant factor
+   */
+  Composition<WaveScale<E>> scale(const double factor) const {
+    return Composition<WaveScale<E>>(WaveScale<E>(expression, factor));
+  }
+
+  /**
+   * Add a constant DC offset to the whole composition
+   */
+  Composition<WaveOffset<E>> offset(const double offset) const {
+    return Composition<WaveOffset<E>>(WaveOffset<E>(expression, offset));
+  }
+
+  template <typename R>
+  Composition<WaveSum<E, R>> operator+(const Composition<R> &other) const {
+    return Composition<WaveSum<E, R>>(
+        WaveSum<E, R>(expression, other.getExpression()));
+  }
+
+  /**
+   * Generate one period of the composed wave into the given buffer, reusing
+   * its capacity
+   *
+   * @param samples output buffer, resized to one period samples count
+   * @param frequency target wave frequency (must be >= 1)
+   * @param peakToPeak peak-to-peak amplitude passed to each composed wave
+   * @param phaseShift shift wave start in radians
+   */
+  template <typename T>
+  void generatePeriod(std::vector<T> &samples, const int frequency,
+                      const double peakToPeak,
+                      const double phaseShift = 0) const {
+    detail::checkFrequency(frequency);
+    detail::checkAmplitude<T>(peakToPeak);
+
+    const int period =
+        detail::calculatePeriodSamplesCount(getSamplingRate(), frequency);
+    const double dcOffset = std::is_unsigned<T>() ? peakToPeak / 2 : 0;
+    WELLE_INSTRUMENT(*this, T, period,
+                     samples.capacity() < (std::size_t)period
+                         ? period * sizeof(T)
+                         : 0);
+
+    // exact size, resize alone could grow capacity geometrically
+    samples.reserve(period);
+    samples.resize(period);
+    for (int i = 0; i < period; i++) {
+      samples[i] = detail::saturate<T>(
+          expression(i, period, peakToPeak, phaseShift) + dcOffset);
+    }
+  }
+
+  /**
+   * Generate one period of the composed wave
+   *
+   * @param frequency target wave frequency (must be >= 1)
+   * @param peakToPeak peak-to-peak amplitude passed to each composed wave
+   * @param phaseShift shift wave start in radians
+   * @return composed wave one period samples
+   */
+  template <typename T>
+  std::vector<T> generatePeriod(const int frequency, const double peakToPeak,
+                                const double phaseShift = 0) const {
+    std::vector<T> samples;
+    generatePeriod(samples, frequency, peakToPeak, phaseShift);
+
+    return samples;
+  }
+
+  /**
+   * Get composition expression tree
+   */
+  const E &getExpression() const { return expression; }
+
+private:
+  const E expression;
+};
+
+namespace detail {
+
+template <RealWaveGenerator W> WaveTerm<W> toExpression(const W &wave) {
+  return WaveTerm<W>(wave);
+}
+
+template <typename E> E toExpression(const Composition<E> &composition) {
+  return composition.getExpression();
+}
+
+} // namespace detail
+
+/**
+ * Floating point wave generator or a composition
+ */
+template <typename C>
+concept Composable = requires(const C &composable) {
+  detail::toExpression(composable);
+};
+
+/**
+ * Compose wave generators and compositions into a single sum evaluated in
+ * one pass, e.g. compose(SineWave<double>(fs), compose(SquareWave<double>(fs))
+ * .scale(0.3)).offset(1)
+ */
+template <Composable First, Composable... Rest>
+auto compose(const First &first, const Rest &...rest) {
+  auto composition = Composition(detail::toExpression(first));
+  if constexpr (sizeof...(rest) == 0) {
+    return composition;
+  } else {
+    return composition + compose(rest...);
+  }
+}
+
+/**
+ * Streaming wave generator with parameters which could be changed while
+ * running.
+ *
+ * One period of the shape is sampled into a wavetable once and read with a
+ * phase accumulator, so parameter updates never regenerate the table.
+ * Frequency, peak-to-peak amplitude and phase shift changes are linearly
+ * ramped over smoothingSamples to avoid discontinuities.
+ */
+template <typename T> class LiveWave {
+public:
+  /**
+   * @param samplingRate output sampling rate (Hz) (must be >=1)
+   * @param shape wave form, its sampling rate defines wavetable size
+   * @param frequency initial wave frequency (must be >= 1)
+   * @param peakToPeak initial peak-to-peak amplitude
+   * @param phaseShift initial phase shift in radians
+   * @param smoothingSamples number of samples to ramp parameter changes over
+   */
+  LiveWave(const int samplingRate, const Wave<double> &shape,
+           const int frequency, const double peakToPeak,
+           const double phaseShift = 0, const int smoothingSamples = 64)
+      : samplingRate{samplingRate}, smoothingSamples{smoothingSamples},
+        table{generateTable(shape, samplingRate, frequency, peakToPeak,
+                            smoothingSamples)} {
+    this->frequency = frequency;
+    this->peakToPeak = peakToPeak;
+    this->phaseShift = phaseShift;
+    increment.reset((double)frequency / samplingRate);
+    amplitude.reset(peakToPeak / 2);
+    phase.reset(phaseShift / (2 * std::numbers::pi));
+  }
+
+  /**
+   * Get output sampling rate (Hz)
+   */
+  int getSamplingRate() const { return samplingRate; }
+
+  int getFrequency() const { return frequency; }
+  double getPeakToPeak() const { return peakToPeak; }
+  double getPhaseShift() const { return phaseShift; }
+
+  /**
+   * Change wave frequency, phase stays continuous
+   *
+   * @param frequency target wave frequency (must be >= 1 and <= Nyquist
+   * frequency)
+   */
+  void setFrequency(const int frequency) {
+    checkFrequency(frequency);
+
+    this->frequency = frequency;
+    increment.rampTo((double)frequency / samplingRate, smoothingSamples);
+  }
+
+  /**
+   * Change peak-to-peak amplitude, rescales the table output without
+   * re-evaluating the wave form
+   *
+   * @param peakToPeak max wave peak-to-peak amplitude
+   */
+  void setPeakToPeak(const double peakToPeak) {
+    detail::checkAmplitude<T>(peakToPeak);
+
+    this->peakToPeak = peakToPeak;
+    amplitude.rampTo(peakToPeak / 2, smoothingSamples);
+  }
+
+  /**
+   * Change phase shift, ramps along the shortest direction
+   *
+   * @param phaseShift shift wave in radians
+   */
+  void setPhaseShift(const double phaseShift) {
+    const double delta = phaseShift / (2 * std::numbers::pi) - phase.target;
+    this->phaseShift = phaseShift;
+    phase.rampTo(phase.target + delta - std::round(delta), smoothingSamples);
+  }
+
+  /**
+   * Generate next sample and advance the wave
+   */
+  inline T nextSample() {
+    double position = readPosition + phase.next();
+    position = (position - std::floor(position)) * table.size();
+
+    const std::size_t index =
+        std::min(static_cast<std::size_t>(position), table.size() - 1);
+    const double fraction = position - index;
+    const double current = table[index];
+    const double next = table[index + 1 < table.size() ? index + 1 : 0];
+
+    const double value = current + (next - current) * fraction;
+    const double halfPeakToPeak = amplitude.next();
+
+    readPosition += increment.next();
+    readPosition -= std::floor(readPosition);
+
+    return detail::saturate<T>((value + dcOffset) * halfPeakToPeak);
+  }
+
+  /**
+   * Fill the whole buffer with next samples
+   *
+   * @param samples output buffer
+   */
+  void generateSamples(std::vector<T> &samples) {
+    WELLE_INSTRUMENT(*this, T, samples.size(), 0);
+
+    for (T &sample : samples) {
+      sample = nextSample();
+    }
+  }
+
+  /**
+   * Generate next samples
+   *
+   * @param count samples count
+   * @return next wave samples
+   */
+  std::vector<T> generateSamples(const int count) {
+    if (count < 0) {
+      throw std::invalid_argument("count must be >= 0");
+    }
+    WELLE_INSTRUMENT(*this, T, count, count * sizeof(T));
+
+    std::vector<T> samples(count);
+    for (T &sample : samples) {
+      sample = nextSample();
+    }
+
+    return samples;
+  }
+
+private:
+  /**
+   * Parameter value linearly ramped towards the target
+   */
+  struct SmoothedValue {
+    double current = 0;
+    double target = 0;
+    double step = 0;
+    int remaining = 0;
+
+    void reset(const double value) {
+      current = target = value;
+      remaining = 0;
+    }
+
+    void rampTo(const double value, const int samples) {
+      target = value;
+      if (samples == 0) {
+        reset(value);
+      } else {
+        step = (target - current) / samples;
+        remaining = samples;
+      }
+    }
+
+    inline double next() {
+      if (remaining > 0) {
+        current = --remaining == 0 ? target : current + step;
+      }
+      return current;
+    }
+  };
+
+  const int samplingRate;
+  const int smoothingSamples;
+  const double dcOffset = std::is_unsigned<T>() ? 1 : 0;
+  const std::vector<double> table;
+
+  int frequency;
+  double peakToPeak;
+  double phaseShift;
+
+  SmoothedValue increment;
+  SmoothedValue amplitude;
+  SmoothedValue phase;
+  double readPosition = 0;
+
+  void checkFrequency(const int frequency) const {
+    detail::checkFrequency(frequency);
+    detail::checkFrequencyVsSamplingRate(frequency, samplingRate);
+  }
+
+  /**
+   * Validate constructor arguments, then sample one shape period
+   */
+  static std::vector<double> generateTable(const Wave<double> &shape,
+                                           const int samplingRate,
+                                           const int frequency,
+                                           const double peakToPeak,
+                                           const int smoothingSamples) {
+    detail::checkSamplingRate(samplingRate);
+    if (smoothingSamples < 0) {
+      throw std::invalid_argument("smoothingSamples must be >= 0");
+    }
+    detail::checkFrequency(frequency);
+    detail::checkFrequencyVsSamplingRate(frequency, samplingRate);
+    detail::checkAmplitude<T>(peakToPeak);
+
+    return shape.generatePeriod(1, 2);
+  }
+};
+
+} // namespace WELLE_ABI_NAMESPACE
 } // namespace welle
 
 #endif // WELLE_HPP
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "../include/Welle.hpp"
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <numbers>
+
+using namespace std;
+using namespace welle;
+
+BOOST_AUTO_TEST_SUITE(Additive_test)
+
+constexpr double diffTolerance = 1e-6;
+
+template <typename T>
+void testSameAsDirectSum(const AdditiveWave<T> &generator, int waveFrequency,
+                         double peakToPeak, double phaseShift = 0) {
+  auto wave = generator.generatePeriod(waveFrequency, peakToPeak, phaseShift);
+
+  BOOST_TEST(wave.size() ==
+             ceil(generator.getSamplingRate() / (double)waveFrequency));
+
+  const int period = wave.size();
+  const double dcOffset = std::is_unsigned<T>() ? 1 : 0;
+  const auto &harmonics = generator.getHarmonics();
+
+  for (int i = 0; i < period; i++) {
+    double sum = 0;
+    for (int k = 1; k <= (int)harmonics.size() && 2 * k <= period; k++) {
+      sum += harmonics[k - 1].amplitude *
+             sin(2 * numbers::pi * k * i / period + k * phaseShift +
+                 harmonics[k - 1].phase);
+    }
+    const T expected = (sum + dcOffset) * peakToPeak / 2;
+
+    // integer types may round to the neighbouring value
+    const double tolerance = std::is_integral<T>() ? 1 : diffTolerance;
+    BOOST_TEST_REQUIRE(abs((double)wave[i] - (double)expected) <= tolerance);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(single_harmonic_matches_sine_test) {
+  const auto sine = SineWave<double>(1000).generatePeriod(10, 2, 0.3);
+  const auto additive =
+      AdditiveWave<double>(1000, {{1, 0}}).generatePeriod(10, 2, 0.3);
+
+  BOOST_TEST_REQUIRE(sine.size() == additive.size());
+  for (unsigned int i = 0; i < sine.size(); i++) {
+    BOOST_TEST_REQUIRE(abs(sine[i] - additive[i]) <= diffTolerance);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(harmonics_sum_test) {
+  const vector<Harmonic> squareLike = {
+      {0.6, 0}, {0, 0}, {0.2, 0}, {0, 0}, {0.12, 0}, {0, 0}, {0.08, 0}};
+
+  // power of two and arbitrary period sizes
+  testSameAsDirectSum(AdditiveWave<double>(1024, squareLike), 1, 10.0);
+  testSameAsDirectSum(AdditiveWave<double>(48000, squareLike), 440, 10.0);
+  testSameAsDirectSum(AdditiveWave<double>(1000, squareLike), 7, 2.0,
+                      numbers::pi / 3);
+  testSameAsDirectSum(AdditiveWave<float>(1000, {{0.5, 1}, {0.5, 2}}), 10,
+                      1.0);
+  // odd and even period sizes with a large prime factor
+  testSameAsDirectSum(AdditiveWave<double>(1009, squareLike), 1, 10.0);
+  testSameAsDirectSum(AdditiveWave<double>(2018, squareLike), 1, 10.0, 1);
+
+  testSameAsDirectSum(AdditiveWave<uint16_t>(48000, squareLike), 440, 4095);
+  testSameAsDirectSum(AdditiveWave<int>(24000, {{0.7, 0}, {0.3, 0.5}}), 22,
+                      1000);
+}
+
+BOOST_AUTO_TEST_CASE(harmonics_above_nyquist_skipped_test) {
+  // period of 10 samples keeps harmonics 1..5 only
+  const auto wave = AdditiveWave<double>(100, {{1, 0}, {0, 0}, {0, 0}, {0, 0},
+                                               {0, 0}, {1, 0}})
+                        .generatePeriod(10, 2);
+  const auto sine = SineWave<double>(100).generatePeriod(10, 2);
+
+  BOOST_TEST_REQUIRE(sine.size() == wave.size());
+  for (unsigned int i = 0; i < sine.size(); i++) {
+    BOOST_TEST_REQUIRE(abs(sine[i] - wave[i]) <= diffTolerance);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(additive_validation_test) {
+  auto generator = AdditiveWave<int8_t>(1000, {{1, 0}});
+  BOOST_REQUIRE_THROW(generator.generatePeriod(0, 10), invalid_argument);
+  BOOST_REQUIRE_THROW(generator.generatePeriod(501, 10), invalid_argument);
+  BOOST_REQUIRE_THROW(generator.generatePeriod(10, 1), invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
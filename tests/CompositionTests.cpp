@@ -0,0 +1,146 @@
+#include "../include/Welle.hpp"
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+using namespace std;
+using namespace welle;
+
+BOOST_AUTO_TEST_SUITE(Composition_test)
+
+constexpr double diffTolerance = 1e-9;
+
+BOOST_AUTO_TEST_CASE(single_wave_matches_generator_test) {
+  const auto sine = SineWave<double>(1000).generatePeriod(10, 10, 0.5);
+  const auto composed =
+      compose(SineWave<double>(1000)).generatePeriod<double>(10, 10, 0.5);
+
+  BOOST_TEST_REQUIRE(sine.size() == composed.size());
+  for (unsigned int i = 0; i < sine.size(); i++) {
+    BOOST_TEST_REQUIRE(abs(sine[i] - composed[i]) <= diffTolerance);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(mixture_matches_elementwise_sum_test) {
+  const int samplingRate = 48000;
+  const auto sine = SineWave<double>(samplingRate).generatePeriod(440, 2);
+  const auto square = SquareWave<double>(samplingRate).generatePeriod(440, 2);
+  const auto saw = SawWave<double>(samplingRate).generatePeriod(440, 2);
+
+  const auto mixture =
+      compose(SineWave<double>(samplingRate),
+              compose(SquareWave<double>(samplingRate)).scale(0.3),
+              SawWave<double>(samplingRate))
+          .scale(0.5)
+          .offset(0.25)
+          .generatePeriod<double>(440, 2);
+
+  BOOST_TEST_REQUIRE(mixture.size() == sine.size());
+  for (unsigned int i = 0; i < sine.size(); i++) {
+    const double expected = (sine[i] + 0.3 * square[i] + saw[i]) * 0.5 + 0.25;
+    BOOST_TEST_REQUIRE(abs(mixture[i] - expected) <= diffTolerance);
+  }
+}
+
+// user-defined generator, doesn't befriend WaveTerm
+class RampWave : public Wave<double> {
+public:
+  using Wave<double>::Wave;
+
+protected:
+  double calculateSampleAtIndex(const int i, const int period,
+                                const double peakToPeak,
+                                const double) const override {
+    return peakToPeak * i / period;
+  }
+};
+
+BOOST_AUTO_TEST_CASE(custom_generator_test) {
+  const auto ramp = RampWave(1000).generatePeriod(10, 2);
+  const auto sine = SineWave<double>(1000).generatePeriod(10, 2);
+  const auto composed = compose(RampWave(1000), SineWave<double>(1000))
+                            .generatePeriod<double>(10, 2);
+
+  BOOST_TEST_REQUIRE(composed.size() == ramp.size());
+  for (unsigned int i = 0; i < ramp.size(); i++) {
+    BOOST_TEST_REQUIRE(abs(composed[i] - (ramp[i] + sine[i])) <=
+                       diffTolerance);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(unsigned_dc_offset_and_rounding_test) {
+  const auto sine = SineWave<double>(1000).generatePeriod(10, 4095);
+  const auto composed =
+      compose(SineWave<double>(1000)).generatePeriod<uint16_t>(10, 4095);
+
+  BOOST_TEST_REQUIRE(sine.size() == composed.size());
+  for (unsigned int i = 0; i < sine.size(); i++) {
+    BOOST_TEST_REQUIRE(composed[i] == round(sine[i] + 4095 / 2.0));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(integer_saturation_test) {
+  // two full scale sines overflow int8_t range
+  const auto wave =
+      compose(SineWave<double>(1000), SineWave<double>(1000))
+          .generatePeriod<int8_t>(10, 200);
+
+  BOOST_TEST(*max_element(wave.begin(), wave.end()) ==
+             numeric_limits<int8_t>::max());
+  BOOST_TEST(*min_element(wave.begin(), wave.end()) ==
+             numeric_limits<int8_t>::lowest());
+
+  const auto unsignedWave =
+      compose(SquareWave<double>(1000)).offset(-100).generatePeriod<uint8_t>(
+          10, 100);
+  BOOST_TEST(*min_element(unsignedWave.begin(), unsignedWave.end()) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(buffer_reuse_test) {
+  const auto composition = compose(SineWave<double>(1000));
+  vector<float> samples(1000);
+
+  composition.generatePeriod(samples, 10, 2);
+  BOOST_TEST(samples.size() == 100);
+  composition.generatePeriod(samples, 50, 2);
+  BOOST_TEST(samples.size() == 20);
+}
+
+template <typename W>
+constexpr bool isComposable = requires(const W &wave) { compose(wave); };
+
+BOOST_AUTO_TEST_CASE(integer_terms_rejected_test) {
+  // integer generators already include own DC offset and truncation
+  static_assert(!isComposable<SineWave<uint16_t>>);
+  static_assert(!isComposable<SquareWave<int>>);
+  static_assert(!isComposable<vector<double>>);
+  static_assert(isComposable<SineWave<double>>);
+  static_assert(isComposable<SawWave<float>>);
+  static_assert(isComposable<decltype(compose(SineWave<double>(1000)))>);
+
+  // float terms produce the same output as an integer generator, but rounded
+  const auto sine = SineWave<uint16_t>(1000).generatePeriod(10, 1000);
+  const auto composed =
+      compose(SineWave<float>(1000)).generatePeriod<uint16_t>(10, 1000);
+  BOOST_TEST(composed[0] == 500);
+  BOOST_TEST_REQUIRE(sine.size() == composed.size());
+  for (unsigned int i = 0; i < sine.size(); i++) {
+    BOOST_TEST_REQUIRE(abs(sine[i] - composed[i]) <= 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(composition_validation_test) {
+  BOOST_REQUIRE_THROW(compose(SineWave<double>(1000), SineWave<double>(2000)),
+                      invalid_argument);
+
+  const auto composition = compose(SineWave<double>(1000));
+  BOOST_REQUIRE_THROW(composition.generatePeriod<int>(0, 10),
+                      invalid_argument);
+  BOOST_REQUIRE_THROW(composition.generatePeriod<int>(501, 10),
+                      invalid_argument);
+  BOOST_REQUIRE_THROW(composition.generatePeriod<int>(10, 1),
+                      invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
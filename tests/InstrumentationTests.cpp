@@ -0,0 +1,317 @@
+#include "../include/Welle.hpp"
+#include <boost/test/unit_test.hpp>
+#include <locale>
+#include <regex>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+
+using namespace std;
+using namespace welle;
+
+BOOST_AUTO_TEST_SUITE(Instrumentation_test)
+
+#ifdef WELLE_INSTRUMENTATION
+
+static vector<instrumentation::GenerationEvent> sinkEvents;
+
+static void collectEvent(const instrumentation::GenerationEvent &event) {
+  sinkEvents.push_back(event);
+}
+
+template <typename W, typename T>
+instrumentation::CountersKey keyOf() {
+  return instrumentation::CountersKey(
+      instrumentation::typeName(typeid(W).name()),
+      instrumentation::typeName(typeid(T).name()));
+}
+
+template <typename W, typename T>
+instrumentation::Counters
+countersOf(const map<instrumentation::CountersKey, instrumentation::Counters>
+               &counters = instrumentation::threadCounters()) {
+  const auto found = counters.find(keyOf<W, T>());
+  return found == counters.end() ? instrumentation::Counters{} : found->second;
+}
+
+BOOST_AUTO_TEST_CASE(thread_counters_test) {
+  instrumentation::resetCounters();
+
+  SineWave<uint16_t>(1000).generatePeriod(10, 100);
+  SineWave<uint16_t>(1000).generatePeriod(50, 100);
+  SquareWave<double>(1000).generatePeriod(10, 1);
+
+  const auto sine = countersOf<SineWave<uint16_t>, uint16_t>();
+  BOOST_TEST(sine.calls == 2);
+  BOOST_TEST(sine.samples == 120);
+  BOOST_TEST(sine.allocatedBytes == 120 * sizeof(uint16_t));
+
+  const auto square = countersOf<SquareWave<double>, double>();
+  BOOST_TEST(square.calls == 1);
+  BOOST_TEST(square.samples == 100);
+
+  instrumentation::resetCounters();
+  const auto reset = countersOf<SquareWave<double>, double>();
+  BOOST_TEST(reset.calls == 0);
+}
+
+BOOST_AUTO_TEST_CASE(other_thread_counters_test) {
+  instrumentation::resetCounters();
+
+  thread worker([] {
+    for (int i = 0; i < 3; i++) {
+      SawWave<int16_t>(1000).generatePeriod(10, 100);
+    }
+  });
+  worker.join();
+  SawWave<int16_t>(1000).generatePeriod(10, 100);
+
+  // calling thread sees own counters only, snapshot aggregates all threads
+  const auto own = countersOf<SawWave<int16_t>, int16_t>();
+  BOOST_TEST(own.calls == 1);
+  const auto all = countersOf<SawWave<int16_t>, int16_t>(
+      instrumentation::snapshotCounters());
+  BOOST_TEST(all.calls == 4);
+  BOOST_TEST(all.samples == 400);
+  BOOST_TEST(instrumentation::threadBlocks().size() >= 2);
+}
+
+BOOST_AUTO_TEST_CASE(exited_thread_block_reuse_test) {
+  instrumentation::resetCounters();
+  SineWave<float>(1000).generatePeriod(10, 1);
+  const size_t blocks = instrumentation::threadBlocks().size();
+
+  for (int i = 0; i < 100; i++) {
+    thread([] { SineWave<float>(1000).generatePeriod(10, 1); }).join();
+  }
+
+  // each exited thread frees its block for the next one, counters are kept
+  BOOST_TEST(instrumentation::threadBlocks().size() <= blocks + 1);
+  const auto all =
+      countersOf<SineWave<float>, float>(instrumentation::snapshotCounters());
+  BOOST_TEST(all.calls == 101);
+  BOOST_TEST(all.samples == 101 * 100);
+  const auto own = countersOf<SineWave<float>, float>();
+  BOOST_TEST(own.calls == 1);
+
+  instrumentation::resetCounters();
+  const auto reset =
+      countersOf<SineWave<float>, float>(instrumentation::snapshotCounters());
+  BOOST_TEST(reset.calls == 0);
+}
+
+BOOST_AUTO_TEST_CASE(composition_buffer_reuse_test) {
+  instrumentation::resetCounters();
+
+  const auto composition = compose(SineWave<double>(1000));
+  vector<int> samples;
+  composition.generatePeriod(samples, 10, 10);
+  composition.generatePeriod(samples, 20, 10);
+
+  const auto counters = countersOf<decltype(composition), int>();
+  BOOST_TEST(counters.calls == 2);
+  BOOST_TEST(counters.samples == 150);
+  // second period fits into the already allocated buffer
+  BOOST_TEST(counters.allocatedBytes == 100 * sizeof(int));
+
+  // growing a buffer allocates exactly one period
+  instrumentation::resetCounters();
+  vector<int> small(100);
+  composition.generatePeriod(small, 7, 10);
+  BOOST_TEST(small.capacity() == 143);
+  const auto grown = countersOf<decltype(composition), int>();
+  BOOST_TEST(grown.allocatedBytes == 143 * sizeof(int));
+}
+
+BOOST_AUTO_TEST_CASE(additive_allocation_test) {
+  // evict the per-thread cached plan, which might already be of this size
+  AdditiveWave<float>(1000, {{1, 0}}).generatePeriod(1, 2);
+
+  sinkEvents.clear();
+  instrumentation::setSink(collectEvent);
+
+  // 1009 samples period is transformed with Bluestein's algorithm
+  const auto generator = AdditiveWave<float>(1009, {{1, 0}});
+  generator.generatePeriod(1, 2);
+  generator.generatePeriod(1, 2);
+
+  instrumentation::setSink(nullptr);
+  BOOST_TEST_REQUIRE(sinkEvents.size() == 2);
+
+  // output, real samples and half spectrum buffers
+  const size_t buffersBytes = 1009 * (sizeof(float) + sizeof(double)) +
+                              (1009 / 2 + 1) * sizeof(complex<double>);
+  BOOST_TEST(sinkEvents[1].allocatedBytes == buffersBytes);
+
+  // first call also allocates the transform plan
+#ifdef WELLE_USE_FFTW
+  BOOST_TEST(sinkEvents[0].allocatedBytes > buffersBytes);
+#else
+  // at least chirp and two 2048 points convolution buffers
+  BOOST_TEST(sinkEvents[0].allocatedBytes >=
+             buffersBytes + (1009 + 2 * 2048) * sizeof(complex<double>));
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(sink_test) {
+  // wavetable generation is recorded as a SineWave call
+  auto live = LiveWave<float>(1000, SineWave<double>(1024), 10, 1);
+
+  sinkEvents.clear();
+  instrumentation::setSink(collectEvent);
+
+  live.generateSamples(64);
+  TriangleWave<int>(1000).generatePeriod(10, 10);
+
+  instrumentation::setSink(nullptr);
+  TriangleWave<int>(1000).generatePeriod(10, 10);
+
+  BOOST_TEST_REQUIRE(sinkEvents.size() == 2);
+  BOOST_TEST(sinkEvents[0].generator == typeid(LiveWave<float>).name());
+  BOOST_TEST(sinkEvents[0].samples == 64);
+  BOOST_TEST(sinkEvents[0].allocatedBytes == 64 * sizeof(float));
+  BOOST_TEST(sinkEvents[1].generator == typeid(TriangleWave<int>).name());
+  BOOST_TEST(sinkEvents[1].sampleType == typeid(int).name());
+  BOOST_TEST(sinkEvents[1].samplesPerSecond() >= 0);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_live_wave_not_recorded_test) {
+  sinkEvents.clear();
+  instrumentation::setSink(collectEvent);
+
+  // wavetable is not generated for invalid arguments
+  BOOST_CHECK_THROW(LiveWave<int>(1000, SineWave<double>(1024), 501, 10),
+                    invalid_argument);
+  auto live = LiveWave<int>(1000, SineWave<double>(1024), 10, 10);
+  BOOST_CHECK_THROW(live.generateSamples(-1), invalid_argument);
+
+  instrumentation::setSink(nullptr);
+  BOOST_TEST_REQUIRE(sinkEvents.size() == 1);
+  BOOST_TEST(sinkEvents[0].generator == typeid(SineWave<double>).name());
+}
+
+template <typename T> class ThrowingWave : public Wave<T> {
+public:
+  using Wave<T>::Wave;
+
+protected:
+  T calculateSampleAtIndex(const int, const int, const double,
+                           const double) const override {
+    throw runtime_error("sample failure");
+  }
+};
+
+BOOST_AUTO_TEST_CASE(failed_call_not_recorded_test) {
+  instrumentation::resetCounters();
+  sinkEvents.clear();
+  instrumentation::setSink(collectEvent);
+
+  BOOST_CHECK_THROW(ThrowingWave<double>(1000).generatePeriod(10, 1),
+                    runtime_error);
+
+  instrumentation::setSink(nullptr);
+  BOOST_TEST(sinkEvents.empty());
+  BOOST_TEST((countersOf<ThrowingWave<double>, double>().calls == 0));
+}
+
+BOOST_AUTO_TEST_CASE(chrome_trace_test) {
+  instrumentation::clearTrace();
+  instrumentation::setTracing(true);
+  AdditiveWave<double>(1000, {{1, 0}}).generatePeriod(10, 2);
+  instrumentation::setTracing(false);
+  SawWave<double>(1000).generatePeriod(10, 2);
+
+  ostringstream trace;
+  instrumentation::writeChromeTrace(trace);
+  const string json = trace.str();
+
+  BOOST_TEST(json.starts_with("{\"traceEvents\":[{"));
+  BOOST_TEST(json.ends_with("}]}"));
+  BOOST_TEST(json.find("\"ph\":\"X\"") != string::npos);
+  BOOST_TEST(json.find("\"samples\":100") != string::npos);
+  BOOST_TEST(json.find("SawWave") == string::npos);
+
+  instrumentation::clearTrace();
+  ostringstream empty;
+  instrumentation::writeChromeTrace(empty);
+  BOOST_TEST(empty.str() == "{\"traceEvents\":[]}");
+}
+
+struct GroupingNumpunct : numpunct<char> {
+  char do_thousands_sep() const override { return ','; }
+  string do_grouping() const override { return "\3"; }
+};
+
+BOOST_AUTO_TEST_CASE(chrome_trace_format_test) {
+  instrumentation::clearTrace();
+  instrumentation::setTracing(true);
+  SawWave<double>(1000).generatePeriod(1, 2);
+  instrumentation::setTracing(false);
+
+  // stream locale and float format don't leak into JSON numbers
+  ostringstream trace;
+  trace.imbue(locale(locale::classic(), new GroupingNumpunct));
+  trace << scientific;
+  instrumentation::writeChromeTrace(trace);
+  const string json = trace.str();
+
+  BOOST_TEST(json.find("\"samples\":1000,") != string::npos);
+  BOOST_TEST(json.find("e+") == string::npos);
+  // microseconds with nanosecond resolution
+  const regex timestamps("\"ts\":[0-9]+\\.[0-9]{3},\"dur\":[0-9]+\\.[0-9]{3},");
+  BOOST_TEST(regex_search(json, timestamps));
+
+  instrumentation::clearTrace();
+}
+
+BOOST_AUTO_TEST_CASE(trace_ring_buffer_test) {
+  instrumentation::clearTrace();
+  instrumentation::setTracing(true);
+
+  thread worker([] { SquareWave<float>(1000).generatePeriod(10, 2); });
+  const auto workerId = worker.get_id();
+  worker.join();
+
+  // oldest events are overwritten once the per-thread buffer is full
+  const auto generator = SineWave<double>(1000);
+  for (size_t i = 0; i < instrumentation::traceCapacityPerThread + 10; i++) {
+    generator.generatePeriod(i < 10 ? 50 : 10, 2);
+  }
+  instrumentation::setTracing(false);
+
+  // exited worker events are kept in its released block
+  size_t events = 0;
+  size_t workerEvents = 0;
+  for (const auto &block : instrumentation::threadBlocks()) {
+    for (const auto &event : block->snapshotTrace()) {
+      BOOST_TEST(event.samples == 100);
+      events++;
+      workerEvents += event.thread == workerId;
+    }
+  }
+  BOOST_TEST(events == instrumentation::traceCapacityPerThread + 1);
+  BOOST_TEST(workerEvents == 1);
+
+  instrumentation::clearTrace();
+}
+
+#endif // WELLE_INSTRUMENTATION
+
+// each configuration is compiled into its own inline namespace
+#if defined(WELLE_INSTRUMENTATION) && defined(WELLE_USE_FFTW)
+namespace abi = welle::abi_instrumented_fftw;
+#elif defined(WELLE_INSTRUMENTATION)
+namespace abi = welle::abi_instrumented;
+#elif defined(WELLE_USE_FFTW)
+namespace abi = welle::abi_fftw;
+#else
+namespace abi = welle::abi_default;
+#endif
+
+BOOST_AUTO_TEST_CASE(abi_namespace_test) {
+  static_assert(is_same_v<SineWave<double>, abi::SineWave<double>>);
+  static_assert(is_same_v<Composition<WaveTerm<SineWave<double>>>,
+                          abi::Composition<abi::WaveTerm<abi::SineWave<double>>>>);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
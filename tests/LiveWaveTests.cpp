@@ -0,0 +1,119 @@
+#include "../include/Welle.hpp"
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <numbers>
+
+using namespace std;
+using namespace welle;
+
+BOOST_AUTO_TEST_SUITE(LiveWave_test)
+
+constexpr int tableSize = 4096;
+
+template <typename T> double maxStep(const vector<T> &samples) {
+  double step = 0;
+  for (unsigned int i = 1; i < samples.size(); i++) {
+    step = fmax(step, abs((double)samples[i] - (double)samples[i - 1]));
+  }
+  return step;
+}
+
+BOOST_AUTO_TEST_CASE(matches_period_generator_test) {
+  auto live = LiveWave<double>(1000, SineWave<double>(tableSize), 10, 10,
+                               numbers::pi / 3);
+  const auto period = SineWave<double>(1000).generatePeriod(10, 10,
+                                                            numbers::pi / 3);
+
+  // several periods in a row
+  for (int p = 0; p < 3; p++) {
+    for (unsigned int i = 0; i < period.size(); i++) {
+      BOOST_TEST_REQUIRE(abs(live.nextSample() - period[i]) <= 1e-4);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(unsigned_dc_offset_test) {
+  auto live = LiveWave<uint16_t>(1000, SineWave<double>(tableSize), 10, 4095);
+  const auto samples = live.generateSamples(100);
+
+  BOOST_TEST(*max_element(samples.begin(), samples.end()) == 4095);
+  BOOST_TEST(*min_element(samples.begin(), samples.end()) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(peak_to_peak_change_is_smoothed_test) {
+  auto live =
+      LiveWave<double>(48000, SineWave<double>(tableSize), 100, 2, 0, 256);
+  live.generateSamples(480);
+
+  // without smoothing amplitude would jump by ~99 in a single sample
+  live.setPeakToPeak(200);
+  BOOST_TEST(live.getPeakToPeak() == 200);
+  BOOST_TEST(maxStep(live.generateSamples(256)) < 2);
+
+  // target amplitude reached after the ramp
+  const auto samples = live.generateSamples(480);
+  BOOST_TEST(abs(*max_element(samples.begin(), samples.end()) - 100) <= 0.01);
+  BOOST_TEST(abs(*min_element(samples.begin(), samples.end()) + 100) <= 0.01);
+}
+
+BOOST_AUTO_TEST_CASE(frequency_change_keeps_phase_continuous_test) {
+  auto live = LiveWave<double>(48000, SineWave<double>(tableSize), 100, 2, 0, 0);
+  auto samples = live.generateSamples(1000);
+
+  live.setFrequency(1000);
+  const auto next = live.generateSamples(1000);
+  samples.insert(samples.end(), next.begin(), next.end());
+
+  // sine derivative limits the step to 2 * pi * f / fs
+  BOOST_TEST(maxStep(samples) <= 2 * numbers::pi * 1000 / 48000 + 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE(phase_shift_change_is_smoothed_test) {
+  // sine moves by ~0.0013 per sample at 10 Hz and 48 kHz, pi/2 shift ramped
+  // over 512 samples adds pi/1024 per sample instead of jumping by ~0.86
+  const double maxSmoothedStep =
+      2 * numbers::pi * 10 / 48000 + numbers::pi / 1024 + 1e-3;
+  auto live = LiveWave<double>(48000, SineWave<double>(tableSize), 10, 2, 0,
+                               512);
+  vector<double> samples = live.generateSamples(100);
+
+  live.setPhaseShift(numbers::pi / 2);
+  BOOST_TEST(live.getPhaseShift() == numbers::pi / 2);
+  for (int i = 0; i < 512; i++) {
+    samples.push_back(live.nextSample());
+  }
+  BOOST_TEST(maxStep(samples) < maxSmoothedStep);
+
+  // shift wraps along the shortest direction, -pi/2 rather than 3pi/2
+  live.setPhaseShift(2 * numbers::pi);
+  for (int i = 0; i < 512; i++) {
+    samples.push_back(live.nextSample());
+  }
+  BOOST_TEST(maxStep(samples) < maxSmoothedStep);
+
+  auto unsmoothed = LiveWave<double>(48000, SineWave<double>(tableSize), 10,
+                                     2, 0, 0);
+  const double before = unsmoothed.generateSamples(100).back();
+  unsmoothed.setPhaseShift(numbers::pi / 2);
+  BOOST_TEST(abs(unsmoothed.nextSample() - before) > 0.5);
+}
+
+BOOST_AUTO_TEST_CASE(live_wave_validation_test) {
+  const auto shape = SineWave<double>(tableSize);
+  BOOST_REQUIRE_THROW(LiveWave<int>(0, shape, 10, 10), invalid_argument);
+  BOOST_REQUIRE_THROW(LiveWave<int>(1000, shape, 0, 10), invalid_argument);
+  BOOST_REQUIRE_THROW(LiveWave<int>(1000, shape, 501, 10), invalid_argument);
+  BOOST_REQUIRE_THROW(LiveWave<int>(1000, shape, 10, 1), invalid_argument);
+  BOOST_REQUIRE_THROW(LiveWave<int>(1000, shape, 10, 10, 0, -1),
+                      invalid_argument);
+
+  auto live = LiveWave<int>(1000, shape, 10, 10);
+  BOOST_REQUIRE_THROW(live.generateSamples(-1), invalid_argument);
+  BOOST_TEST(live.generateSamples(0).empty());
+  BOOST_REQUIRE_THROW(live.setFrequency(501), invalid_argument);
+  BOOST_REQUIRE_THROW(live.setPeakToPeak(1), invalid_argument);
+  BOOST_TEST(live.getFrequency() == 10);
+  BOOST_TEST(live.getPeakToPeak() == 10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()